@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+#
+# Boot the emulator several times headless and report where the boot time
+# goes. Every run gets its own boot-prof-filename and is stopped once the
+# shell prompt shows up on the console (or on timeout).
+#
+# usage: ./boot-bench.py [-n RUNS] [-t TIMEOUT] [-k TOP_KEXTS] -- QEMU ARGS...
+#
+# The QEMU command line is the one from the README. The -M option gets
+# boot-prof-filename appended to it.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def percentile(values, p):
+    values = sorted(values)
+    if not values:
+        return 0.0
+    idx = (len(values) - 1) * p / 100.0
+    lo = int(idx)
+    hi = min(lo + 1, len(values) - 1)
+    return values[lo] + (values[hi] - values[lo]) * (idx - lo)
+
+
+def add_prof_arg(qemu_args, prof_path):
+    args = list(qemu_args)
+    for i, arg in enumerate(args[:-1]):
+        if arg in ('-M', '-machine'):
+            args[i + 1] = '%s,boot-prof-filename=%s' % (args[i + 1],
+                                                         prof_path)
+            return args
+    sys.exit('the QEMU command line has no -M option')
+
+
+def parse_profile(path):
+    host = {}
+    guest = {}
+    kext_begin = {}
+    kexts = {}
+    with open(path) as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) < 3:
+                continue
+            usec = int(parts[0])
+            kind = parts[1]
+            if kind == 'host' and len(parts) >= 4:
+                host[parts[2]] = int(parts[3])
+            elif kind == 'guest':
+                guest.setdefault(parts[2], usec)
+            elif kind == 'kext-begin':
+                kext_begin.setdefault(parts[2], usec)
+            elif kind == 'kext-end':
+                if parts[2] in kext_begin and parts[2] not in kexts:
+                    kexts[parts[2]] = usec - kext_begin[parts[2]]
+    return host, guest, kexts
+
+
+def run_once(qemu_args, timeout, workdir, run):
+    prof_path = os.path.join(workdir, 'boot-prof-%d.txt' % run)
+    log_path = os.path.join(workdir, 'console-%d.log' % run)
+    args = add_prof_arg(qemu_args, prof_path)
+
+    start = time.monotonic()
+    with open(log_path, 'wb') as log:
+        proc = subprocess.Popen(args, stdin=subprocess.DEVNULL, stdout=log,
+                                stderr=subprocess.STDOUT)
+        done = False
+        while time.monotonic() - start < timeout:
+            if proc.poll() is not None:
+                break
+            if os.path.exists(prof_path):
+                with open(prof_path) as f:
+                    if ' guest shell-prompt' in f.read():
+                        done = True
+                        break
+            time.sleep(0.2)
+        wall = time.monotonic() - start
+        proc.terminate()
+        try:
+            proc.wait(10)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+            proc.wait()
+
+    if not done:
+        print('run %d: no shell prompt after %.1fs, see %s' %
+              (run, wall, log_path), file=sys.stderr)
+        return None
+
+    host, guest, kexts = parse_profile(prof_path)
+    return wall, host, guest, kexts
+
+
+def print_table(title, rows):
+    print(title)
+    print('  %-44s %10s %10s %10s %10s' % ('', 'p50', 'p90', 'p99', 'max'))
+    for name, values in rows:
+        print('  %-44s %10.1f %10.1f %10.1f %10.1f' %
+              (name, percentile(values, 50), percentile(values, 90),
+               percentile(values, 99), max(values)))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='boot the emulator several times and report the boot '
+                    'phase timings')
+    parser.add_argument('-n', '--runs', type=int, default=5)
+    parser.add_argument('-t', '--timeout', type=float, default=600.0,
+                        help='seconds to wait for the shell prompt')
+    parser.add_argument('-k', '--top-kexts', type=int, default=15)
+    parser.add_argument('-o', '--output-dir',
+                        help='keep the profiles and console logs here')
+    parser.add_argument('qemu', nargs=argparse.REMAINDER)
+    opts = parser.parse_args()
+
+    qemu_args = opts.qemu
+    if qemu_args and qemu_args[0] == '--':
+        qemu_args = qemu_args[1:]
+    if not qemu_args:
+        parser.error('missing the QEMU command line')
+
+    workdir = opts.output_dir or tempfile.mkdtemp(prefix='boot-bench-')
+    os.makedirs(workdir, exist_ok=True)
+
+    results = []
+    for run in range(opts.runs):
+        res = run_once(qemu_args, opts.timeout, workdir, run)
+        if res is not None:
+            print('run %d: shell prompt after %.1fs' % (run, res[0]))
+            results.append(res)
+    print()
+
+    if not results:
+        sys.exit('no run reached the shell prompt')
+
+    print('%d of %d runs reached the shell prompt, profiles in %s\n' %
+          (len(results), opts.runs, workdir))
+
+    print_table('wall clock to shell prompt (s)',
+                [('total', [r[0] for r in results])])
+
+    host_names = []
+    for r in results:
+        host_names += [n for n in r[1] if n not in host_names]
+    print_table('host setup phases (ms)',
+                [(n, [r[1][n] / 1000.0 for r in results if n in r[1]])
+                 for n in host_names])
+
+    guest_names = []
+    for r in results:
+        guest_names += [n for n in sorted(r[2], key=r[2].get)
+                        if n not in guest_names]
+    print_table('guest milestones since machine init (s)',
+                [(n, [r[2][n] / 1e6 for r in results if n in r[2]])
+                 for n in guest_names])
+
+    kexts = {}
+    for r in results:
+        for name, usec in r[3].items():
+            kexts.setdefault(name, []).append(usec / 1000.0)
+    top = sorted(kexts.items(), key=lambda kv: percentile(kv[1], 50),
+                 reverse=True)[:opts.top_kexts]
+    print_table('top %d kexts by load time (ms)' % len(top), top)
+
+
+if __name__ == '__main__':
+    main()
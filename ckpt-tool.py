@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+#
+# Read the incremental checkpoints written with checkpoint-filename. The
+# layout is described in include/hw/arm/xnu_checkpoint.h.
+#
+# usage: ./ckpt-tool.py FILE list
+#        ./ckpt-tool.py FILE regs [-c SEQ]
+#        ./ckpt-tool.py FILE dump [-c SEQ] [-f MAP=PATH]... GPA SIZE OUTPUT
+#
+# SEQ defaults to the last complete checkpoint. dump writes the guest
+# physical memory [GPA, GPA + SIZE) as it was at that checkpoint, the pages
+# no checkpoint up to SEQ has are zeros, or for the maps of a file (the
+# ramdisk) the content of the file given with -f for the map name.
+
+import argparse
+import mmap
+import struct
+import sys
+
+FILE_HDR = struct.Struct('<8sQQ')
+RECORD = struct.Struct('<8s9Q')
+CPU = struct.Struct('<II32QQQ4Q4Q8QQQ64Q')
+CPREG = struct.Struct('<QQ')
+MAP = struct.Struct('<QQQQ64s')
+MAP_FILE = 1
+PAGE = struct.Struct('<QQ')
+
+
+class Record(object):
+    def __init__(self, buf, offset):
+        (magic, self.size, self.seq, self.vm_clock_ns, self.n_cpus,
+         self.cpus_offset, self.n_maps, self.maps_offset, self.n_pages,
+         self.pages_offset) = RECORD.unpack_from(buf, offset)
+        if magic != b'XNUCKREC':
+            raise ValueError('bad record magic at 0x%x' % offset)
+        self.offset = offset
+
+    def cpus(self, buf):
+        offset = self.cpus_offset
+        for _ in range(self.n_cpus):
+            cpu = CPU.unpack_from(buf, offset)
+            offset += CPU.size
+            cpregs = [CPREG.unpack_from(buf, offset + i * CPREG.size)
+                      for i in range(cpu[1])]
+            offset += cpu[1] * CPREG.size
+            yield cpu, cpregs
+
+    def maps(self, buf):
+        for i in range(self.n_maps):
+            gpa, size, flags, file_offset, name = MAP.unpack_from(
+                buf, self.maps_offset + i * MAP.size)
+            yield gpa, size, flags, file_offset, name.rstrip(b'\0').decode()
+
+    def pages(self, buf):
+        for i in range(self.n_pages):
+            yield PAGE.unpack_from(buf, self.pages_offset + i * PAGE.size)
+
+
+def read_records(buf):
+    magic, page_size, offset = FILE_HDR.unpack_from(buf, 0)
+    if magic != b'XNUCKPT1':
+        sys.exit('not a checkpoint file')
+    records = []
+    while offset + RECORD.size <= len(buf):
+        rec = Record(buf, offset)
+        if 0 == rec.size:
+            # still being written, or the emulator died while writing it
+            break
+        records.append(rec)
+        offset += rec.size
+    return page_size, records
+
+
+def pick(records, seq):
+    if not records:
+        sys.exit('no complete checkpoint')
+    if seq is None:
+        return records[-1].seq
+    if seq > records[-1].seq:
+        sys.exit('no checkpoint %d' % seq)
+    return seq
+
+
+# the registers are in the KVM encoding, KVM_REG_ARM64_SYSREG for the
+# AArch64 system registers
+def cpreg_name(index):
+    if 0x13 != (index >> 16) & 0xffff:
+        return '0x%x' % index
+    return 's%d_%d_c%d_c%d_%d' % ((index >> 14) & 3, (index >> 11) & 7,
+                                  (index >> 7) & 15, (index >> 3) & 15,
+                                  index & 7)
+
+
+def cmd_list(buf, page_size, records, opts):
+    for rec in records:
+        data = sum(1 for _, off in rec.pages(buf) if off)
+        print('%4d  vm clock %.3fs  %d pages (%d with data)  %d bytes' %
+              (rec.seq, rec.vm_clock_ns / 1e9, rec.n_pages, data, rec.size))
+    if records:
+        print('maps:')
+        for gpa, size, flags, file_offset, name in records[-1].maps(buf):
+            print('  0x%016x-0x%016x %s%s' %
+                  (gpa, gpa + size, name,
+                   ' (file at 0x%x)' % file_offset if flags & MAP_FILE
+                   else ''))
+
+
+def cmd_regs(buf, page_size, records, opts):
+    seq = pick(records, opts.checkpoint)
+    for cpu, cpregs in records[seq].cpus(buf):
+        xregs = cpu[2:34]
+        pc, pstate = cpu[34:36]
+        sp_el = cpu[36:40]
+        elr_el = cpu[40:44]
+        print('cpu %d: pc 0x%016x pstate 0x%08x el%d' %
+              (cpu[0], pc, pstate, (pstate >> 2) & 3))
+        for i in range(0, 32, 4):
+            print('  ' + '  '.join('%-3s 0x%016x' %
+                                   ('sp' if 31 == i + j else 'x%d' % (i + j),
+                                    xregs[i + j]) for j in range(4)))
+        print('  ' + '  '.join('sp_el%d 0x%016x' % (i, sp_el[i])
+                               for i in range(4)))
+        print('  ' + '  '.join('elr_el%d 0x%016x' % (i, elr_el[i])
+                               for i in range(4)))
+        for index, value in cpregs:
+            print('  %-20s 0x%016x' % (cpreg_name(index), value))
+
+
+def cmd_dump(buf, page_size, records, opts):
+    seq = pick(records, opts.checkpoint)
+    gpa = int(opts.gpa, 0)
+    size = int(opts.size, 0)
+    image = bytearray(size)
+    files = dict(f.split('=', 1) for f in opts.file)
+    for map_gpa, map_size, flags, file_offset, name in records[seq].maps(buf):
+        lo = max(map_gpa, gpa)
+        hi = min(map_gpa + map_size, gpa + size)
+        if not flags & MAP_FILE or lo >= hi:
+            continue
+        if name not in files:
+            sys.exit('the pages of %s are in its file, use -f %s=PATH' %
+                     (name, name))
+        with open(files[name], 'rb') as f:
+            f.seek(file_offset + lo - map_gpa)
+            data = f.read(hi - lo)
+        image[lo - gpa:lo - gpa + len(data)] = data
+    for rec in records[:seq + 1]:
+        for page_gpa, off in rec.pages(buf):
+            lo = max(page_gpa, gpa)
+            hi = min(page_gpa + page_size, gpa + size)
+            if lo >= hi:
+                continue
+            if off:
+                src = off + lo - page_gpa
+                image[lo - gpa:hi - gpa] = buf[src:src + hi - lo]
+            else:
+                image[lo - gpa:hi - gpa] = bytes(hi - lo)
+    with open(opts.output, 'wb') as f:
+        f.write(image)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='read the incremental checkpoints of the emulator')
+    parser.add_argument('file')
+    sub = parser.add_subparsers(dest='cmd')
+    sub.required = True
+    sub.add_parser('list').set_defaults(func=cmd_list)
+    regs = sub.add_parser('regs')
+    regs.add_argument('-c', '--checkpoint', type=int)
+    regs.set_defaults(func=cmd_regs)
+    dump = sub.add_parser('dump')
+    dump.add_argument('-c', '--checkpoint', type=int)
+    dump.add_argument('-f', '--file', action='append', default=[])
+    dump.add_argument('gpa')
+    dump.add_argument('size')
+    dump.add_argument('output')
+    dump.set_defaults(func=cmd_dump)
+    opts = parser.parse_args()
+
+    with open(opts.file, 'rb') as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        page_size, records = read_records(buf)
+        opts.func(buf, page_size, records, opts)
+
+
+if __name__ == '__main__':
+    main()
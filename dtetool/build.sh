@@ -3,4 +3,6 @@
 echo -n 'const char *usage_text = ' > usage.h
 fold -w 80 -s -b usage | sed 's/.*/"\0\\n"/g' >> usage.h
 echo -n ';' >> usage.h
-gcc dtefunc.c dtetool.c -g -Wall -o dtetool
+LZFSE_DIR=${LZFSE_DIR:-../lzfse}
+gcc dtefunc.c dtetool.c im4p.c -g -Wall -I$LZFSE_DIR/src -o dtetool \
+    $LZFSE_DIR/build/bin/liblzfse.a
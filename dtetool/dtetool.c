@@ -10,6 +10,7 @@
 #include <linux/limits.h>
 #include "dtetool.h"
 #include "dtefunc.h"
+#include "im4p.h"
 
 char *dt_buf = NULL;
 size_t dt_size = 0;
@@ -51,6 +52,18 @@ int main(int argc, char *argv[]) {
     dt_buf = get_file_buf(fname_input, &dt_size);
     if (dt_buf  == NULL)
         return 1;
+
+    // Unwrap and decompress an IM4P device tree in memory
+    char *im4p_buf = NULL;
+    size_t im4p_size = 0;
+    int im4p = im4p_decode(dt_buf, dt_size, &im4p_buf, &im4p_size);
+    if (im4p < 0)
+        return 1;
+    if (im4p) {
+        munmap(dt_buf, dt_size);
+        dt_buf = im4p_buf;
+        dt_size = im4p_size;
+    }
     if (!read_dt_entry((DTEntry *)dt_buf, root)) {
         printf("ERROR: device tree read failed\n");
         del_dte(root);
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lzfse.h>
+#include "im4p.h"
+
+// DER element, p points to the value
+typedef struct der {
+    uint8_t tag;
+    uint8_t *p;
+    size_t len;
+} der;
+
+// Reads the DER element at *pos and moves *pos past it
+static int der_next(uint8_t **pos, uint8_t *end, der *elem) {
+    uint8_t *p = *pos;
+    size_t len;
+    if (end - p < 2)
+        return 0;
+    elem->tag = *p++;
+    len = *p++;
+    if (len & 0x80) {
+        int count = len & 0x7f;
+        if (count == 0 || count > 8 || end - p < count)
+            return 0;
+        for (len = 0; count > 0; count--)
+            len = (len << 8) | *p++;
+    }
+    if ((size_t)(end - p) < len)
+        return 0;
+    elem->p = p;
+    elem->len = len;
+    *pos = p + len;
+    return 1;
+}
+
+static uint64_t der_uint(der *elem) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < elem->len; i++)
+        value = (value << 8) | elem->p[i];
+    return value;
+}
+
+// Returns the payload of an IM4P file in a new buffer, decompressed if it
+// is LZFSE. Returns 1 on success, 0 if buf is not an IM4P file and -1 if
+// the payload can't be decompressed.
+int im4p_decode(char *buf, size_t size, char **out, size_t *out_size) {
+    uint8_t *pos = (uint8_t *)buf;
+    uint8_t *end = pos + size;
+    der seq, elem, payload;
+    size_t raw_size = 0;
+
+    // IM4P ::= SEQUENCE { "IM4P", type, description, payload,
+    //                     keybag OPTIONAL, SEQUENCE { algo, size } OPTIONAL }
+    if (!der_next(&pos, end, &seq) || seq.tag != 0x30)
+        return 0;
+    pos = seq.p;
+    end = seq.p + seq.len;
+    if (!der_next(&pos, end, &elem) || elem.tag != 0x16 || elem.len != 4 ||
+            memcmp(elem.p, "IM4P", 4))
+        return 0;
+    for (int i = 0; i < 2; i++) {
+        if (!der_next(&pos, end, &elem) || elem.tag != 0x16)
+            return 0;
+    }
+    if (!der_next(&pos, end, &payload) || payload.tag != 0x04)
+        return 0;
+    while (der_next(&pos, end, &elem)) {
+        uint8_t *cpos = elem.p;
+        der algo, csize;
+        if (elem.tag == 0x30 &&
+                der_next(&cpos, elem.p + elem.len, &algo) &&
+                der_next(&cpos, elem.p + elem.len, &csize) &&
+                der_uint(&algo) == 1)
+            raw_size = der_uint(&csize);
+    }
+
+    // Not compressed
+    if (payload.len < 4 || memcmp(payload.p, "bvx", 3)) {
+        *out = malloc(payload.len);
+        memcpy(*out, payload.p, payload.len);
+        *out_size = payload.len;
+        return 1;
+    }
+
+    // Grow the buffer until the whole output fits if the size is unknown,
+    // one spare byte tells a full buffer from a truncated output
+    void *scratch = malloc(lzfse_decode_scratch_size());
+    size_t buf_size = raw_size ? raw_size + 1 : payload.len * 4;
+    char *ret;
+    for (;;) {
+        ret = malloc(buf_size);
+        *out_size = lzfse_decode_buffer((uint8_t *)ret, buf_size, payload.p,
+                                        payload.len, scratch);
+        if (*out_size < buf_size || raw_size)
+            break;
+        free(ret);
+        buf_size *= 2;
+    }
+    free(scratch);
+    if (*out_size == 0 || *out_size == buf_size) {
+        printf("ERROR: IM4P payload decompression failed\n");
+        free(ret);
+        return -1;
+    }
+    *out = ret;
+    return 1;
+}
@@ -0,0 +1,3 @@
+#include <stddef.h>
+
+int im4p_decode(char *buf, size_t size, char **out, size_t *out_size);
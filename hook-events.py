@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+#
+# Print the events the hooks write to the event ring of the hook globals
+# while the guest runs. The emulator has to be started with
+# hook-globals-shm and a hook-globals-size large enough for a ring, the
+# layout is described in include/hw/arm/guest-services/hook-events.h.
+#
+# usage: ./hook-events.py [-a] [-1] SHM
+#
+# SHM is the shm name (read from /dev/shm) or a path. Without -a only the
+# events written from now on are printed, with -1 the ring is printed once
+# instead of followed.
+
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+# the globals start HOOK_GLOBALS_SHM_OFFSET into the shm and the ring
+# HOOK_EVENTS_OFFSET into the globals
+EVENTS_OFFSET = 0x4C00 + 0x400
+EVENTS_MAGIC = 0x5456454b4f4f48
+HDR = struct.Struct('<QQQQ32x')
+EVENT = struct.Struct('<QQQ5Q')
+HEAD_OFFSET = EVENTS_OFFSET + 24
+
+
+def shm_path(name):
+    if os.path.exists(name):
+        return name
+    return os.path.join('/dev/shm', name.lstrip('/'))
+
+
+def read_event(buf, n_events, pos):
+    off = EVENTS_OFFSET + HDR.size + (pos % n_events) * EVENT.size
+    seq = struct.unpack_from('<Q', buf, off)[0]
+    if seq != pos + 1:
+        return seq, None
+    event = EVENT.unpack_from(buf, off)
+    # the hook may have started overwriting it while it was copied
+    if struct.unpack_from('<Q', buf, off)[0] != seq:
+        return seq, None
+    return seq, event
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='print the events of the hook globals event ring')
+    parser.add_argument('-a', '--all', action='store_true',
+                        help='start from the oldest event in the ring')
+    parser.add_argument('-1', '--once', action='store_true',
+                        help="don't follow the ring")
+    parser.add_argument('shm')
+    opts = parser.parse_args()
+
+    with open(shm_path(opts.shm), 'rb') as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    magic, n_events, timer_freq, head = HDR.unpack_from(buf, EVENTS_OFFSET)
+    if magic != EVENTS_MAGIC:
+        sys.exit('no event ring, is hook-globals-size larger than 0x400?')
+
+    pos = max(head - n_events, 0) if opts.all else head
+    lost = 0
+    while True:
+        head = struct.unpack_from('<Q', buf, HEAD_OFFSET)[0]
+        if opts.once and pos >= head:
+            break
+        seq, event = read_event(buf, n_events, pos)
+        if event is None:
+            if seq > pos + 1 or head - pos > n_events:
+                # lapped by the hooks, skip to the oldest event left
+                new_pos = max(head - n_events, pos + 1)
+                lost += new_pos - pos
+                pos = new_pos
+                continue
+            if opts.once:
+                break
+            time.sleep(0.01)
+            continue
+        _, ts, ident, *args = event
+        print('%.9f %d %s' % (ts / timer_freq if timer_freq else ts, ident,
+                              ' '.join('0x%x' % a for a in args)))
+        pos += 1
+
+    if lost:
+        print('%d events lost' % lost, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass